@@ -0,0 +1,233 @@
+/*
+
+ Copyright (C) 2026 Alexis Bienvenüe <paamc@passoire.fr>
+
+ This file is part of Auto-Multiple-Choice
+
+ Auto-Multiple-Choice is free software: you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation, either version 2 of
+ the License, or (at your option) any later version.
+
+ Auto-Multiple-Choice is distributed in the hope that it will be
+ useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Auto-Multiple-Choice.  If not, see
+ <http://www.gnu.org/licenses/>.
+
+*/
+
+/* AMC-detect-bench measures the time spent by the AMC-detect
+   functions (load_image, pre_traitement, calage, optim, omit_optim,
+   mesure_case) on synthetic scans (see synth.cc), for several
+   resolutions and numbers of boxes. Run it with "make bench-detect".
+
+   Options:
+   -n reps   : number of timed runs for each kernel (default 10)
+   -d list   : comma-separated resolutions, in DPI (default 150,300,600)
+   -b list   : comma-separated numbers of boxes (default 50,200,800)
+   -j n      : number of OpenCV threads
+
+   For each kernel, the mean, standard deviation, minimum and median
+   times of the runs are reported, in milliseconds. optim and
+   omit_optim are very fast, so that they are called BENCH_OPTIM_CALLS
+   times for each run, and the time reported is for one call.
+*/
+
+#define AMC_DETECT_NO_MAIN
+#include "AMC-detect.cc"
+
+#include "synth.cc"
+
+#define BENCH_OPTIM_CALLS 10000
+
+/* TIMINGS */
+
+typedef struct {
+  vector<double> t;
+  double debut;
+} mesures;
+
+void top(mesures *m) {
+  m->debut = temps_reel();
+}
+
+void fin(mesures *m, double diviseur=1) {
+  m->t.push_back((temps_reel() - m->debut) * 1000 / diviseur);
+}
+
+void affiche(const char *noyau, int dpi, int n_cases, mesures *m) {
+  vector<double> t = m->t;
+  double somme = 0, somme2 = 0;
+
+  sort(t.begin(), t.end());
+  for(size_t i = 0; i < t.size(); i++) {
+    somme += t[i];
+    somme2 += t[i] * t[i];
+  }
+  double moyenne = somme / t.size();
+  double variance = somme2 / t.size() - moyenne * moyenne;
+  double mediane = (t.size() % 2 ? t[t.size() / 2]
+                    : (t[t.size() / 2 - 1] + t[t.size() / 2]) / 2);
+
+  printf("%-16s %5d %6d %12.4f %10.4f %12.4f %12.4f\n",
+         noyau, dpi, n_cases, moyenne,
+         sqrt(variance > 0 ? variance : 0), t[0], mediane);
+  fflush(stdout);
+}
+
+vector<int> liste_entiers(const char *s) {
+  vector<int> l;
+  char *fin;
+  while(*s) {
+    long v = strtol(s, &fin, 10);
+    if(fin == s) break;
+    l.push_back((int)v);
+    s = fin;
+    if(*s == ',') s++;
+  }
+  return(l);
+}
+
+/* bench(dpi, n_cases, n_runs, dir) runs all the kernels for one
+   synthetic scan. */
+
+void bench(int dpi, int n_cases, int n_runs, const char *dir) {
+  page_synth ps;
+  synth_init(&ps);
+  ps.dpi = dpi;
+  vector<case_synth> cases = synth_cases(n_cases, SYNTH_CARRE, "random",
+                                         0.3, ps.graine);
+  cv::Mat page = synth_page(&ps, cases);
+  char fichier[1024];
+  snprintf(fichier, sizeof(fichier), "%s/page-%d-%d.png", dir, dpi, n_cases);
+  cv::imwrite(fichier, page);
+  page.release();
+
+  double dia = SYNTH_MARQUE;
+  double tol_plus = 0.2, tol_moins = 0.2;
+  double coins_x[4], coins_y[4];
+  double coins_x0[4], coins_y0[4];
+  linear_transform transfo, transfo_back;
+  cv::Mat src, illustr, dst;
+  bitmap noirs;
+  mesures m_load, m_pre, m_calage, m_optim, m_omit, m_mesure;
+
+  synth_coins(coins_x0, coins_y0);
+
+  /* same smoothing radii as in calage */
+  double target = dia * dpi / 25.4;
+  int lissage_trous = 1 + (int)(target / 20);
+  int lissage_poussieres = 1 + (int)(target / 8);
+
+  for(int run = -1; run < n_runs; run++) {
+    /* run -1 is a warm-up run, that is not reported */
+    mesures poubelle;
+    mesures *m;
+
+    m = (run < 0 ? &poubelle : &m_load);
+    top(m);
+    load_image(src, fichier, 0, 0.6);
+    fin(m);
+
+    cv::Mat copie = src.clone();
+    m = (run < 0 ? &poubelle : &m_pre);
+    top(m);
+    pre_traitement(copie, lissage_trous, lissage_poussieres);
+    fin(m);
+
+    copie = src.clone();
+    m = (run < 0 ? &poubelle : &m_calage);
+    top(m);
+    calage(copie, illustr, SYNTH_X, SYNTH_Y, dia, tol_plus, tol_moins, 3,
+           coins_x, coins_y, dst, 0, 0.25);
+    fin(m);
+
+    m = (run < 0 ? &poubelle : &m_optim);
+    top(m);
+    for(int i = 0; i < BENCH_OPTIM_CALLS; i++)
+      optim(coins_x0, coins_y0, coins_x, coins_y, 4, &transfo);
+    fin(m, BENCH_OPTIM_CALLS);
+
+    m = (run < 0 ? &poubelle : &m_omit);
+    top(m);
+    for(int i = 0; i < BENCH_OPTIM_CALLS; i++)
+      omit_optim(coins_x0, coins_y0, coins_x, coins_y, 4, &transfo);
+    fin(m, BENCH_OPTIM_CALLS);
+
+    optim(coins_x0, coins_y0, coins_x, coins_y, 4, &transfo);
+    revert_transform(&transfo, &transfo_back);
+    compacte_noirs(src, &noirs);
+    integrale_noirs(src, &noirs);
+
+    m = (run < 0 ? &poubelle : &m_mesure);
+    top(m);
+    for(size_t i = 0; i < cases.size(); i++) {
+      mesure_case0(src, illustr, ILLUSTR_BOX, 1, 1,
+                   cases[i].question, cases[i].answer,
+                   0.1, (char*)"square",
+                   cases[i].xmin, cases[i].xmax, cases[i].ymin, cases[i].ymax,
+                   &transfo, &transfo_back, dst, NULL, 0, &noirs);
+    }
+    fin(m);
+  }
+
+  affiche("load_image", dpi, n_cases, &m_load);
+  affiche("pre_traitement", dpi, n_cases, &m_pre);
+  affiche("calage", dpi, n_cases, &m_calage);
+  affiche("optim", dpi, n_cases, &m_optim);
+  affiche("omit_optim", dpi, n_cases, &m_omit);
+  affiche("mesure_case", dpi, n_cases, &m_mesure);
+
+  unlink(fichier);
+}
+
+int main(int argc, char** argv)
+{
+  int n_runs = 10;
+  vector<int> dpis = liste_entiers("150,300,600");
+  vector<int> n_cases = liste_entiers("50,200,800");
+  int c;
+
+  setlocale(LC_ALL, "POSIX");
+  choix_simd();
+
+  while ((c = getopt(argc, argv, "n:d:b:j:")) != -1) {
+    switch (c) {
+    case 'n': n_runs = atoi(optarg); break;
+    case 'd': dpis = liste_entiers(optarg); break;
+    case 'b': n_cases = liste_entiers(optarg); break;
+    case 'j': cv::setNumThreads(atoi(optarg)); break;
+    }
+  }
+  if(n_runs < 1) n_runs = 1;
+
+  char dir[] = "/tmp/AMC-bench-XXXXXX";
+  if(mkdtemp(dir) == NULL) {
+    fprintf(stderr, "Can't create temporary directory: %s\n", strerror(errno));
+    return(1);
+  }
+
+  /* AMC-detect messages are discarded */
+  sortie = fopen("/dev/null", "w");
+  if(sortie == NULL) {
+    fprintf(stderr, "Can't open /dev/null: %s\n", strerror(errno));
+    return(1);
+  }
+
+  printf("%-16s %5s %6s %12s %10s %12s %12s\n",
+         "kernel", "dpi", "boxes", "mean(ms)", "sd(ms)", "min(ms)", "median(ms)");
+
+  for(size_t i = 0; i < dpis.size(); i++)
+    for(size_t j = 0; j < n_cases.size(); j++)
+      bench(dpis[i], n_cases[j], n_runs, dir);
+
+  fclose(sortie);
+  rmdir(dir);
+  zooms_arrete();
+
+  return(0);
+}
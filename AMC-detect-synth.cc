@@ -0,0 +1,163 @@
+/*
+
+ Copyright (C) 2026 Alexis Bienvenüe <paamc@passoire.fr>
+
+ This file is part of Auto-Multiple-Choice
+
+ Auto-Multiple-Choice is free software: you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation, either version 2 of
+ the License, or (at your option) any later version.
+
+ Auto-Multiple-Choice is distributed in the hope that it will be
+ useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Auto-Multiple-Choice.  If not, see
+ <http://www.gnu.org/licenses/>.
+
+*/
+
+/* AMC-detect-synth writes a synthetic scan (see synth.cc), with the
+   AMC-detect commands to process it, and the expected results.
+
+   Options:
+   -o file   : scan image file to be written (required)
+   -c file   : AMC-detect commands file (default: standard output)
+   -t file   : ground truth file
+   -d dpi    : resolution (default 300)
+   -n n      : number of boxes (default 100)
+   -s shape  : boxes shape: square, oval or mixed (default square)
+   -a angle  : rotation, in degrees (default 0)
+   -k skew   : skew factor (default 0)
+   -b noise  : noise level, from 0 to 1 (default 0)
+   -f fill   : fill pattern: none, all, alternate, random or one
+               (default one, see synth_cases)
+   -p prop   : filled boxes proportion for the random pattern
+               (default 0.3)
+   -r seed   : random seed (default 1)
+   -1        : measure each box with its own mesure0 command, that all
+               AMC-detect versions understand
+
+   The commands file loads the scan, fits the corner marks, and
+   measures all the boxes with one mesurepage command (student 1,
+   page 1), or with one "id" and one "mesure0" command per box with
+   option -1. AMC-detect has to be run with the options given in the
+   first line of the ground truth file, which are
+
+   -x 210 -y 297 -d 4
+
+   The following lines of the ground truth file are "question answer
+   ticked", ticked being 1 for the filled boxes and 0 for the others.
+
+*/
+
+#include "synth.cc"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+
+#if CV_MAJOR_VERSION > 2
+  #include "opencv2/imgcodecs/imgcodecs.hpp"
+#else
+  #include "opencv2/highgui/highgui.hpp"
+#endif
+
+#define SYNTH_PROP 0.1
+
+FILE *ouvre(const char *file) {
+  FILE *f = fopen(file, "w");
+  if(f == NULL) {
+    fprintf(stderr, "Can't open %s: %s\n", file, strerror(errno));
+    exit(1);
+  }
+  return(f);
+}
+
+int main(int argc, char** argv)
+{
+  page_synth p;
+  char *image_file = NULL;
+  char *commandes_file = NULL;
+  char *verite_file = NULL;
+  int n_cases = 100;
+  int forme = SYNTH_CARRE;
+  const char *remplissage = "one";
+  double proportion = 0.3;
+  double coins_x[4], coins_y[4];
+  int une_par_case = 0;
+  int c;
+
+  synth_init(&p);
+
+  while ((c = getopt(argc, argv, "o:c:t:d:n:s:a:k:b:f:p:r:1")) != -1) {
+    switch (c) {
+    case 'o': image_file = optarg; break;
+    case 'c': commandes_file = optarg; break;
+    case 't': verite_file = optarg; break;
+    case 'd': p.dpi = atoi(optarg); break;
+    case 'n': n_cases = atoi(optarg); break;
+    case 's':
+      forme = (strcmp(optarg, "oval") == 0 ? SYNTH_OVALE :
+               strcmp(optarg, "mixed") == 0 ? SYNTH_MIXTE : SYNTH_CARRE);
+      break;
+    case 'a': p.rotation = atof(optarg); break;
+    case 'k': p.biais = atof(optarg); break;
+    case 'b': p.bruit = atof(optarg); break;
+    case 'f': remplissage = optarg; break;
+    case 'p': proportion = atof(optarg); break;
+    case 'r': p.graine = atoi(optarg); break;
+    case '1': une_par_case = 1; break;
+    }
+  }
+
+  if(image_file == NULL) {
+    fprintf(stderr, "Option -o is required\n");
+    return(1);
+  }
+
+  vector<case_synth> cases = synth_cases(n_cases, forme, remplissage,
+                                         proportion, p.graine);
+  cv::Mat page = synth_page(&p, cases);
+
+  if(!cv::imwrite(image_file, page)) {
+    fprintf(stderr, "Can't write image %s\n", image_file);
+    return(1);
+  }
+
+  FILE *commandes = (commandes_file == NULL ? stdout : ouvre(commandes_file));
+  synth_coins(coins_x, coins_y);
+  fprintf(commandes, "load %s\n", image_file);
+  fprintf(commandes, "optim %g,%g %g,%g %g,%g %g,%g\n",
+          coins_x[0], coins_y[0], coins_x[1], coins_y[1],
+          coins_x[2], coins_y[2], coins_x[3], coins_y[3]);
+  if(!une_par_case)
+    fprintf(commandes, "mesurepage 1 1 %d\n", (int)cases.size());
+  for(size_t i = 0; i < cases.size(); i++) {
+    if(une_par_case)
+      fprintf(commandes, "id 1 1 %d %d\nmesure0 ",
+              cases[i].question, cases[i].answer);
+    else
+      fprintf(commandes, "%d %d ", cases[i].question, cases[i].answer);
+    fprintf(commandes, "%g %s %g %g %g %g\n", SYNTH_PROP,
+            cases[i].forme == SYNTH_OVALE ? "oval" : "square",
+            cases[i].xmin, cases[i].xmax, cases[i].ymin, cases[i].ymax);
+  }
+  if(commandes != stdout) fclose(commandes);
+
+  if(verite_file != NULL) {
+    FILE *verite = ouvre(verite_file);
+    fprintf(verite, "-x %g -y %g -d %g\n", SYNTH_X, SYNTH_Y, SYNTH_MARQUE);
+    for(size_t i = 0; i < cases.size(); i++) {
+      fprintf(verite, "%d %d %d\n",
+              cases[i].question, cases[i].answer, cases[i].cochee);
+    }
+    fclose(verite);
+  }
+
+  return(0);
+}
@@ -315,6 +315,15 @@ sub commande_mesure0 {
     return ($c);
 }
 
+# renvoie la ligne decrivant la boite pour une commande mesurepage de
+# AMC-detect.
+
+sub ligne_mesurepage {
+    my ( $self, $question, $answer, $prop, $shape ) = (@_);
+    return ( join( ' ', $question, $answer, $prop, $shape,
+            $self->etendue_xy('xy') ) );
+}
+
 # renvoie les coordonnees du centre de la boite.
 
 sub centre {
@@ -190,7 +190,7 @@ sub sql_quote {
 sub sql_do {
     my ( $self, $sql, @bind ) = @_;
     debug_and_stderr "WARNING: sql_do with no transaction -- $sql"
-      if ( $sql !~ /^\s*(attach|begin)/i && !$self->{trans} );
+      if ( $sql !~ /^\s*(attach|detach|begin)/i && !$self->{trans} );
     $self->{dbh}->do( $sql, {}, @bind );
 }
 
@@ -230,6 +230,27 @@ sub require_module {
     }
 }
 
+# attach($name,$filename) attaches the database file $filename, that
+# is not a module database, as $name (outside any transaction), and
+# detach($name) detaches it.
+
+sub attach {
+    my ( $self, $name, $filename ) = @_;
+    debug "Attaching $filename as $name...";
+    $self->{dbh}->{AutoCommit}     = 1;
+    $self->{dbh}->{sqlite_unicode} = 0;
+    $self->sql_do( "ATTACH DATABASE ? AS $name", $filename );
+    $self->{dbh}->{sqlite_unicode} = 1;
+    $self->{dbh}->{AutoCommit}     = 0;
+}
+
+sub detach {
+    my ( $self, $name ) = @_;
+    $self->{dbh}->{AutoCommit} = 1;
+    $self->sql_do("DETACH DATABASE $name");
+    $self->{dbh}->{AutoCommit} = 0;
+}
+
 # module($module) returns the module object associated to module
 # $module (call the methods from module $module from this object).
 
@@ -158,6 +158,8 @@ use constant {
 
     POSITION_BOX     => 1,
     POSITION_MEASURE => 2,
+
+    DETECT_VERSION => 1,
 };
 
 our @EXPORT_OK = qw(ZONE_FRAME ZONE_NAME ZONE_DIGIT ZONE_BOX
@@ -1532,6 +1534,69 @@ sub set_corner {
     $self->statement('NEWPosition')->execute( $zoneid, $corner, $x, $y, $type );
 }
 
+# detect_type($column,%types) is the SQL expression that converts the
+# names used in column $column of the AMC-detect capture file to the
+# values given by %types.
+
+sub detect_type {
+    my ( $column, %types ) = @_;
+    return ( "CASE $column "
+          . join( ' ', map { "WHEN '$_' THEN $types{$_}" } sort keys %types )
+          . " END" );
+}
+
+# import_detect($detect,$student,$page,$copy) imports the boxes
+# measurements that AMC-detect has written to its capture file (see
+# CAPTURE FILE in AMC-detect.cc), attached as database $detect, to the
+# zones of page ($student,$page,$copy): the zones that are not yet in
+# the database are created, and their pixels counts, zooms and corners
+# are set. It returns 1, or 0 (and imports nothing) if the capture
+# file format is not the expected one.
+
+sub import_detect {
+    my ( $self, $detect, $student, $page, $copy ) = @_;
+
+    my $version = $self->sql_single(
+        "SELECT value FROM $detect.variables WHERE name='version'");
+    if ( !defined($version) || $version != DETECT_VERSION ) {
+        debug "Unknown AMC-detect capture file version: "
+          . ( defined($version) ? $version : '(none)' );
+        return (0);
+    }
+
+    my $t_zone     = $self->table("zone");
+    my $zone       = $self->table( "zone", "self" );
+    my $t_position = $self->table("position");
+    my %zone_types = ( digit => ZONE_DIGIT, box => ZONE_BOX );
+
+    my $type = detect_type( "d.kind", %zone_types );
+    $self->sql_do( "INSERT OR IGNORE INTO $t_zone"
+          . " (student,page,copy,type,id_a,id_b)"
+          . " SELECT ?,?,?,$type,d.id_a,d.id_b FROM $detect.zone AS d",
+        $student, $page, $copy );
+    $self->sql_do( "UPDATE $t_zone"
+          . " SET total=d.total, black=d.black, image=NULL,"
+          . " imagedata=d.imagedata FROM $detect.zone AS d"
+          . " WHERE $zone.student=? AND $zone.page=? AND $zone.copy=?"
+          . " AND $zone.type=$type"
+          . " AND $zone.id_a=d.id_a AND $zone.id_b=d.id_b",
+        $student, $page, $copy );
+
+    $type = detect_type( "p.kind", %zone_types );
+    my $position_type = detect_type( "p.type",
+        box     => POSITION_BOX,
+        measure => POSITION_MEASURE );
+    $self->sql_do( "INSERT OR REPLACE INTO $t_position"
+          . " (zoneid,corner,x,y,type)"
+          . " SELECT z.zoneid,p.corner,p.x,p.y,$position_type"
+          . " FROM $detect.position AS p JOIN $t_zone AS z"
+          . " ON z.student=? AND z.page=? AND z.copy=? AND z.type=$type"
+          . " AND z.id_a=p.id_a AND z.id_b=p.id_b",
+        $student, $page, $copy );
+
+    return (1);
+}
+
 # zone_images($student,$copy,$type) returns a list of the image values
 # of zones corresponding to $student,$value,$type.
 
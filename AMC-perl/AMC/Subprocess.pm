@@ -24,6 +24,7 @@ package AMC::Subprocess;
 
 use AMC::Basic;
 use IPC::Open2;
+use IO::Socket::UNIX;
 
 sub new {
     my (%o) = (@_);
@@ -36,6 +37,9 @@ sub new {
         first_arg => '',
         mode      => 'detect',
         exec_file => '',
+        socket    => '',
+        server    => 0,
+        owner     => 0,
     };
 
     for my $k ( keys %o ) {
@@ -49,7 +53,7 @@ sub new {
         }
     }
 
-    if ( !commande_accessible( $self->{exec_file} ) ) {
+    if ( !$self->{socket} && !commande_accessible( $self->{exec_file} ) ) {
         die "AMC::Subprocess: No program to execute";
     }
 
@@ -69,6 +73,24 @@ sub commande {
     my ( $self, @cmd ) = (@_);
     my @r = ();
 
+    if ( !$self->{ipc} && $self->{socket} ) {
+
+        # connects to an AMC-detect server (see AMC-detect -L option):
+        # the connection is then used as the subprocess input and
+        # output
+
+        debug "Connecting to $self->{socket}...";
+        $self->{ipc_in} = IO::Socket::UNIX->new(
+            Type => SOCK_STREAM(),
+            Peer => $self->{socket}
+        ) or die "AMC::Subprocess: can't connect to $self->{socket}: $!";
+        $self->{ipc_out} = $self->{ipc_in};
+        $self->{ipc}     = 'socket';
+        $self->{owner}   = $$;
+        $self->{times}   = [ times() ];
+        binmode $self->{ipc_in}, ':utf8';
+    }
+
     if ( !$self->{ipc} ) {
         debug "Exec subprocess...";
         my @a =
@@ -79,6 +101,7 @@ sub commande {
         $self->{ipc} =
           open2( $self->{ipc_out}, $self->{ipc_in}, $self->{exec_file}, @a );
 
+        $self->{owner} = $$;
         binmode $self->{ipc_out}, ':utf8';
         binmode $self->{ipc_in},  ':utf8';
         debug "PID="
@@ -108,11 +131,27 @@ sub commande {
 
 sub ferme_commande {
     my ($self) = (@_);
+
+    # processes forked after the subprocess has been started (see
+    # AMC::Queue) must leave it to their parent
+    return if ( $self->{ipc} && $self->{owner} != $$ );
+
     if ( $self->{ipc} ) {
-        debug "Image sending QUIT";
-        $self->commande("quit");
-        debug "Wait for PID $self->{ipc}";
-        waitpid $self->{ipc}, 0;
+        if ( $self->{server} ) {
+
+            # an AMC-detect server ends when its input is closed
+            debug "Closing server input";
+            close( $self->{ipc_in} );
+        } else {
+            debug "Image sending QUIT";
+            $self->commande("quit");
+        }
+        if ( $self->{socket} ) {
+            close( $self->{ipc_in} );
+        } else {
+            debug "Wait for PID $self->{ipc}";
+            waitpid $self->{ipc}, 0;
+        }
         $self->{ipc}     = '';
         $self->{ipc_in}  = '';
         $self->{ipc_out} = '';
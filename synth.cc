@@ -0,0 +1,214 @@
+/*
+
+ Copyright (C) 2026 Alexis Bienvenüe <paamc@passoire.fr>
+
+ This file is part of Auto-Multiple-Choice
+
+ Auto-Multiple-Choice is free software: you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation, either version 2 of
+ the License, or (at your option) any later version.
+
+ Auto-Multiple-Choice is distributed in the hope that it will be
+ useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with Auto-Multiple-Choice.  If not, see
+ <http://www.gnu.org/licenses/>.
+
+*/
+
+/* SYNTHETIC SCANS
+
+   Synthetic scans are used to benchmark and check AMC-detect
+   without LaTeX, printing nor scanning (see AMC-detect-synth.cc and
+   AMC-detect-bench.cc).
+
+   The subject is an A4 page (coordinates in mm, from the upper-left
+   corner), with four corner marks (discs with diameter
+   SYNTH_MARQUE, centered SYNTH_MARGE mm from the page sides), and
+   boxes placed on a grid of SYNTH_COLONNES columns between them.
+
+   The page is drawn at the requested resolution, then rotated
+   (around the page center) and skewed, and some noise is added: grey
+   level noise on all pixels, and small dusts.
+
+*/
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <random>
+
+#include "opencv2/core/core.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+using namespace std;
+
+#define SYNTH_X 210.0
+#define SYNTH_Y 297.0
+#define SYNTH_MARQUE 4.0
+#define SYNTH_MARGE 10.0
+#define SYNTH_CASE 3.5
+#define SYNTH_COLONNES 20
+#define SYNTH_REPONSES 5
+
+#define SYNTH_CARRE 0
+#define SYNTH_OVALE 1
+#define SYNTH_MIXTE 2
+
+typedef struct {
+  int question, answer;
+  int forme;                 // SYNTH_CARRE or SYNTH_OVALE
+  int cochee;                // 1 if the box is filled
+  double xmin, xmax, ymin, ymax;
+} case_synth;
+
+typedef struct {
+  int dpi;
+  double rotation;           // in degrees
+  double biais;              // skew: x is shifted by biais*y
+  double bruit;              // noise level, from 0 to 1
+  unsigned int graine;       // random seed
+} page_synth;
+
+void synth_init(page_synth *p) {
+  p->dpi = 300;
+  p->rotation = 0;
+  p->biais = 0;
+  p->bruit = 0;
+  p->graine = 1;
+}
+
+/* synth_coins(x,y) gives the subject positions of the corner marks
+   centers, in the order used by the optim command (UL UR BR BL). */
+
+void synth_coins(double *x, double *y) {
+  x[0] = SYNTH_MARGE;           y[0] = SYNTH_MARGE;
+  x[1] = SYNTH_X - SYNTH_MARGE; y[1] = SYNTH_MARGE;
+  x[2] = SYNTH_X - SYNTH_MARGE; y[2] = SYNTH_Y - SYNTH_MARGE;
+  x[3] = SYNTH_MARGE;           y[3] = SYNTH_Y - SYNTH_MARGE;
+}
+
+/* synth_cases(n, forme, remplissage, proportion, graine) returns n
+   boxes. Each question has SYNTH_REPONSES boxes. forme is the boxes
+   shape (SYNTH_MIXTE for alternate square and oval questions).
+   remplissage is the fill pattern:
+
+   - "none" or "all"
+   - "alternate": one box out of two is filled
+   - "random": each box is filled with probability proportion
+   - "one": one random box is filled for each question
+*/
+
+vector<case_synth> synth_cases(int n, int forme, const char *remplissage,
+                               double proportion, unsigned int graine) {
+  vector<case_synth> cases;
+  mt19937 alea(graine);
+  int lignes = (n + SYNTH_COLONNES - 1) / SYNTH_COLONNES;
+  double pas_x = (SYNTH_X - 4 * SYNTH_MARGE) / SYNTH_COLONNES;
+  double pas_y = (SYNTH_Y - 4 * SYNTH_MARGE) / (lignes < 20 ? 20 : lignes);
+  int choisie = 0;
+
+  for(int i = 0; i < n; i++) {
+    case_synth c;
+    c.question = 1 + i / SYNTH_REPONSES;
+    c.answer = 1 + i % SYNTH_REPONSES;
+    c.forme = (forme == SYNTH_MIXTE ? (c.question % 2 ? SYNTH_CARRE : SYNTH_OVALE)
+               : forme);
+    c.xmin = 2 * SYNTH_MARGE + (i % SYNTH_COLONNES) * pas_x;
+    c.ymin = 2 * SYNTH_MARGE + (i / SYNTH_COLONNES) * pas_y;
+    c.xmax = c.xmin + SYNTH_CASE;
+    c.ymax = c.ymin + SYNTH_CASE;
+
+    if(c.answer == 1) choisie = 1 + (int)(alea() % SYNTH_REPONSES);
+    double u = alea() / (alea.max() + 1.0);
+    if(strcmp(remplissage, "all") == 0) {
+      c.cochee = 1;
+    } else if(strcmp(remplissage, "alternate") == 0) {
+      c.cochee = (i % 2 == 0);
+    } else if(strcmp(remplissage, "random") == 0) {
+      c.cochee = (u < proportion);
+    } else if(strcmp(remplissage, "one") == 0) {
+      c.cochee = (c.answer == choisie);
+    } else {
+      c.cochee = 0;
+    }
+    cases.push_back(c);
+  }
+  return(cases);
+}
+
+/* synth_page(p, cases) draws the scan (greyscale, white background). */
+
+cv::Mat synth_page(page_synth *p, vector<case_synth> &cases) {
+  double r = p->dpi / 25.4;
+  int epaisseur = 1 + p->dpi / 300;
+  double coins_x[4], coins_y[4];
+  cv::Mat page((int)(SYNTH_Y * r), (int)(SYNTH_X * r), CV_8UC1,
+               cv::Scalar(255));
+
+  synth_coins(coins_x, coins_y);
+  for(int i = 0; i < 4; i++) {
+    cv::circle(page, cv::Point((int)(coins_x[i] * r), (int)(coins_y[i] * r)),
+               (int)(SYNTH_MARQUE * r / 2), cv::Scalar(0), -1);
+  }
+
+  for(size_t i = 0; i < cases.size(); i++) {
+    case_synth *c = &cases[i];
+    int t = (c->cochee ? -1 : epaisseur);
+    if(c->forme == SYNTH_OVALE) {
+      cv::ellipse(page,
+                  cv::Point((int)((c->xmin + c->xmax) / 2 * r),
+                            (int)((c->ymin + c->ymax) / 2 * r)),
+                  cv::Size((int)((c->xmax - c->xmin) / 2 * r),
+                           (int)((c->ymax - c->ymin) / 2 * r)),
+                  0, 0, 360, cv::Scalar(0), t);
+    } else {
+      cv::rectangle(page,
+                    cv::Point((int)(c->xmin * r), (int)(c->ymin * r)),
+                    cv::Point((int)(c->xmax * r), (int)(c->ymax * r)),
+                    cv::Scalar(0), t);
+    }
+  }
+
+  /* rotation around the page center, and skew */
+
+  if(p->rotation != 0 || p->biais != 0) {
+    double a = p->rotation * M_PI / 180;
+    double cx = page.cols / 2.0, cy = page.rows / 2.0;
+    cv::Mat m(2, 3, CV_64FC1);
+    double *t = (double*)m.data;
+    t[0] = cos(a); t[1] = -sin(a) + p->biais * cos(a);
+    t[3] = sin(a); t[4] = cos(a) + p->biais * sin(a);
+    t[2] = cx - t[0] * cx - t[1] * cy;
+    t[5] = cy - t[3] * cx - t[4] * cy;
+    cv::Mat tournee;
+    cv::warpAffine(page, tournee, m, page.size(), cv::INTER_LINEAR,
+                   cv::BORDER_CONSTANT, cv::Scalar(255));
+    page = tournee;
+  }
+
+  /* noise */
+
+  if(p->bruit > 0) {
+    mt19937 alea(p->graine);
+    int amplitude = (int)(p->bruit * 128);
+    for(int y = 0; y < page.rows; y++) {
+      uchar *l = page.ptr<uchar>(y);
+      for(int x = 0; x < page.cols; x++) {
+        int v = l[x] + (int)(alea() % (2 * amplitude + 1)) - amplitude;
+        l[x] = (uchar)(v < 0 ? 0 : v > 255 ? 255 : v);
+      }
+    }
+    long poussieres = (long)(p->bruit * 1e-4 * page.rows * page.cols);
+    for(long i = 0; i < poussieres; i++) {
+      cv::circle(page, cv::Point(alea() % page.cols, alea() % page.rows),
+                 alea() % (1 + p->dpi / 300), cv::Scalar(0), -1);
+    }
+  }
+
+  return(page);
+}
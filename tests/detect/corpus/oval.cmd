@@ -0,0 +1,802 @@
+load oval.png
+optim 10,10 200,10 200,287 10,287
+id 1 1 1 1
+mesure0 0.1 oval 20 23.5 20 23.5
+id 1 1 1 2
+mesure0 0.1 oval 28.5 32 20 23.5
+id 1 1 1 3
+mesure0 0.1 oval 37 40.5 20 23.5
+id 1 1 1 4
+mesure0 0.1 oval 45.5 49 20 23.5
+id 1 1 1 5
+mesure0 0.1 oval 54 57.5 20 23.5
+id 1 1 2 1
+mesure0 0.1 oval 62.5 66 20 23.5
+id 1 1 2 2
+mesure0 0.1 oval 71 74.5 20 23.5
+id 1 1 2 3
+mesure0 0.1 oval 79.5 83 20 23.5
+id 1 1 2 4
+mesure0 0.1 oval 88 91.5 20 23.5
+id 1 1 2 5
+mesure0 0.1 oval 96.5 100 20 23.5
+id 1 1 3 1
+mesure0 0.1 oval 105 108.5 20 23.5
+id 1 1 3 2
+mesure0 0.1 oval 113.5 117 20 23.5
+id 1 1 3 3
+mesure0 0.1 oval 122 125.5 20 23.5
+id 1 1 3 4
+mesure0 0.1 oval 130.5 134 20 23.5
+id 1 1 3 5
+mesure0 0.1 oval 139 142.5 20 23.5
+id 1 1 4 1
+mesure0 0.1 oval 147.5 151 20 23.5
+id 1 1 4 2
+mesure0 0.1 oval 156 159.5 20 23.5
+id 1 1 4 3
+mesure0 0.1 oval 164.5 168 20 23.5
+id 1 1 4 4
+mesure0 0.1 oval 173 176.5 20 23.5
+id 1 1 4 5
+mesure0 0.1 oval 181.5 185 20 23.5
+id 1 1 5 1
+mesure0 0.1 oval 20 23.5 32.85 36.35
+id 1 1 5 2
+mesure0 0.1 oval 28.5 32 32.85 36.35
+id 1 1 5 3
+mesure0 0.1 oval 37 40.5 32.85 36.35
+id 1 1 5 4
+mesure0 0.1 oval 45.5 49 32.85 36.35
+id 1 1 5 5
+mesure0 0.1 oval 54 57.5 32.85 36.35
+id 1 1 6 1
+mesure0 0.1 oval 62.5 66 32.85 36.35
+id 1 1 6 2
+mesure0 0.1 oval 71 74.5 32.85 36.35
+id 1 1 6 3
+mesure0 0.1 oval 79.5 83 32.85 36.35
+id 1 1 6 4
+mesure0 0.1 oval 88 91.5 32.85 36.35
+id 1 1 6 5
+mesure0 0.1 oval 96.5 100 32.85 36.35
+id 1 1 7 1
+mesure0 0.1 oval 105 108.5 32.85 36.35
+id 1 1 7 2
+mesure0 0.1 oval 113.5 117 32.85 36.35
+id 1 1 7 3
+mesure0 0.1 oval 122 125.5 32.85 36.35
+id 1 1 7 4
+mesure0 0.1 oval 130.5 134 32.85 36.35
+id 1 1 7 5
+mesure0 0.1 oval 139 142.5 32.85 36.35
+id 1 1 8 1
+mesure0 0.1 oval 147.5 151 32.85 36.35
+id 1 1 8 2
+mesure0 0.1 oval 156 159.5 32.85 36.35
+id 1 1 8 3
+mesure0 0.1 oval 164.5 168 32.85 36.35
+id 1 1 8 4
+mesure0 0.1 oval 173 176.5 32.85 36.35
+id 1 1 8 5
+mesure0 0.1 oval 181.5 185 32.85 36.35
+id 1 1 9 1
+mesure0 0.1 oval 20 23.5 45.7 49.2
+id 1 1 9 2
+mesure0 0.1 oval 28.5 32 45.7 49.2
+id 1 1 9 3
+mesure0 0.1 oval 37 40.5 45.7 49.2
+id 1 1 9 4
+mesure0 0.1 oval 45.5 49 45.7 49.2
+id 1 1 9 5
+mesure0 0.1 oval 54 57.5 45.7 49.2
+id 1 1 10 1
+mesure0 0.1 oval 62.5 66 45.7 49.2
+id 1 1 10 2
+mesure0 0.1 oval 71 74.5 45.7 49.2
+id 1 1 10 3
+mesure0 0.1 oval 79.5 83 45.7 49.2
+id 1 1 10 4
+mesure0 0.1 oval 88 91.5 45.7 49.2
+id 1 1 10 5
+mesure0 0.1 oval 96.5 100 45.7 49.2
+id 1 1 11 1
+mesure0 0.1 oval 105 108.5 45.7 49.2
+id 1 1 11 2
+mesure0 0.1 oval 113.5 117 45.7 49.2
+id 1 1 11 3
+mesure0 0.1 oval 122 125.5 45.7 49.2
+id 1 1 11 4
+mesure0 0.1 oval 130.5 134 45.7 49.2
+id 1 1 11 5
+mesure0 0.1 oval 139 142.5 45.7 49.2
+id 1 1 12 1
+mesure0 0.1 oval 147.5 151 45.7 49.2
+id 1 1 12 2
+mesure0 0.1 oval 156 159.5 45.7 49.2
+id 1 1 12 3
+mesure0 0.1 oval 164.5 168 45.7 49.2
+id 1 1 12 4
+mesure0 0.1 oval 173 176.5 45.7 49.2
+id 1 1 12 5
+mesure0 0.1 oval 181.5 185 45.7 49.2
+id 1 1 13 1
+mesure0 0.1 oval 20 23.5 58.55 62.05
+id 1 1 13 2
+mesure0 0.1 oval 28.5 32 58.55 62.05
+id 1 1 13 3
+mesure0 0.1 oval 37 40.5 58.55 62.05
+id 1 1 13 4
+mesure0 0.1 oval 45.5 49 58.55 62.05
+id 1 1 13 5
+mesure0 0.1 oval 54 57.5 58.55 62.05
+id 1 1 14 1
+mesure0 0.1 oval 62.5 66 58.55 62.05
+id 1 1 14 2
+mesure0 0.1 oval 71 74.5 58.55 62.05
+id 1 1 14 3
+mesure0 0.1 oval 79.5 83 58.55 62.05
+id 1 1 14 4
+mesure0 0.1 oval 88 91.5 58.55 62.05
+id 1 1 14 5
+mesure0 0.1 oval 96.5 100 58.55 62.05
+id 1 1 15 1
+mesure0 0.1 oval 105 108.5 58.55 62.05
+id 1 1 15 2
+mesure0 0.1 oval 113.5 117 58.55 62.05
+id 1 1 15 3
+mesure0 0.1 oval 122 125.5 58.55 62.05
+id 1 1 15 4
+mesure0 0.1 oval 130.5 134 58.55 62.05
+id 1 1 15 5
+mesure0 0.1 oval 139 142.5 58.55 62.05
+id 1 1 16 1
+mesure0 0.1 oval 147.5 151 58.55 62.05
+id 1 1 16 2
+mesure0 0.1 oval 156 159.5 58.55 62.05
+id 1 1 16 3
+mesure0 0.1 oval 164.5 168 58.55 62.05
+id 1 1 16 4
+mesure0 0.1 oval 173 176.5 58.55 62.05
+id 1 1 16 5
+mesure0 0.1 oval 181.5 185 58.55 62.05
+id 1 1 17 1
+mesure0 0.1 oval 20 23.5 71.4 74.9
+id 1 1 17 2
+mesure0 0.1 oval 28.5 32 71.4 74.9
+id 1 1 17 3
+mesure0 0.1 oval 37 40.5 71.4 74.9
+id 1 1 17 4
+mesure0 0.1 oval 45.5 49 71.4 74.9
+id 1 1 17 5
+mesure0 0.1 oval 54 57.5 71.4 74.9
+id 1 1 18 1
+mesure0 0.1 oval 62.5 66 71.4 74.9
+id 1 1 18 2
+mesure0 0.1 oval 71 74.5 71.4 74.9
+id 1 1 18 3
+mesure0 0.1 oval 79.5 83 71.4 74.9
+id 1 1 18 4
+mesure0 0.1 oval 88 91.5 71.4 74.9
+id 1 1 18 5
+mesure0 0.1 oval 96.5 100 71.4 74.9
+id 1 1 19 1
+mesure0 0.1 oval 105 108.5 71.4 74.9
+id 1 1 19 2
+mesure0 0.1 oval 113.5 117 71.4 74.9
+id 1 1 19 3
+mesure0 0.1 oval 122 125.5 71.4 74.9
+id 1 1 19 4
+mesure0 0.1 oval 130.5 134 71.4 74.9
+id 1 1 19 5
+mesure0 0.1 oval 139 142.5 71.4 74.9
+id 1 1 20 1
+mesure0 0.1 oval 147.5 151 71.4 74.9
+id 1 1 20 2
+mesure0 0.1 oval 156 159.5 71.4 74.9
+id 1 1 20 3
+mesure0 0.1 oval 164.5 168 71.4 74.9
+id 1 1 20 4
+mesure0 0.1 oval 173 176.5 71.4 74.9
+id 1 1 20 5
+mesure0 0.1 oval 181.5 185 71.4 74.9
+id 1 1 21 1
+mesure0 0.1 oval 20 23.5 84.25 87.75
+id 1 1 21 2
+mesure0 0.1 oval 28.5 32 84.25 87.75
+id 1 1 21 3
+mesure0 0.1 oval 37 40.5 84.25 87.75
+id 1 1 21 4
+mesure0 0.1 oval 45.5 49 84.25 87.75
+id 1 1 21 5
+mesure0 0.1 oval 54 57.5 84.25 87.75
+id 1 1 22 1
+mesure0 0.1 oval 62.5 66 84.25 87.75
+id 1 1 22 2
+mesure0 0.1 oval 71 74.5 84.25 87.75
+id 1 1 22 3
+mesure0 0.1 oval 79.5 83 84.25 87.75
+id 1 1 22 4
+mesure0 0.1 oval 88 91.5 84.25 87.75
+id 1 1 22 5
+mesure0 0.1 oval 96.5 100 84.25 87.75
+id 1 1 23 1
+mesure0 0.1 oval 105 108.5 84.25 87.75
+id 1 1 23 2
+mesure0 0.1 oval 113.5 117 84.25 87.75
+id 1 1 23 3
+mesure0 0.1 oval 122 125.5 84.25 87.75
+id 1 1 23 4
+mesure0 0.1 oval 130.5 134 84.25 87.75
+id 1 1 23 5
+mesure0 0.1 oval 139 142.5 84.25 87.75
+id 1 1 24 1
+mesure0 0.1 oval 147.5 151 84.25 87.75
+id 1 1 24 2
+mesure0 0.1 oval 156 159.5 84.25 87.75
+id 1 1 24 3
+mesure0 0.1 oval 164.5 168 84.25 87.75
+id 1 1 24 4
+mesure0 0.1 oval 173 176.5 84.25 87.75
+id 1 1 24 5
+mesure0 0.1 oval 181.5 185 84.25 87.75
+id 1 1 25 1
+mesure0 0.1 oval 20 23.5 97.1 100.6
+id 1 1 25 2
+mesure0 0.1 oval 28.5 32 97.1 100.6
+id 1 1 25 3
+mesure0 0.1 oval 37 40.5 97.1 100.6
+id 1 1 25 4
+mesure0 0.1 oval 45.5 49 97.1 100.6
+id 1 1 25 5
+mesure0 0.1 oval 54 57.5 97.1 100.6
+id 1 1 26 1
+mesure0 0.1 oval 62.5 66 97.1 100.6
+id 1 1 26 2
+mesure0 0.1 oval 71 74.5 97.1 100.6
+id 1 1 26 3
+mesure0 0.1 oval 79.5 83 97.1 100.6
+id 1 1 26 4
+mesure0 0.1 oval 88 91.5 97.1 100.6
+id 1 1 26 5
+mesure0 0.1 oval 96.5 100 97.1 100.6
+id 1 1 27 1
+mesure0 0.1 oval 105 108.5 97.1 100.6
+id 1 1 27 2
+mesure0 0.1 oval 113.5 117 97.1 100.6
+id 1 1 27 3
+mesure0 0.1 oval 122 125.5 97.1 100.6
+id 1 1 27 4
+mesure0 0.1 oval 130.5 134 97.1 100.6
+id 1 1 27 5
+mesure0 0.1 oval 139 142.5 97.1 100.6
+id 1 1 28 1
+mesure0 0.1 oval 147.5 151 97.1 100.6
+id 1 1 28 2
+mesure0 0.1 oval 156 159.5 97.1 100.6
+id 1 1 28 3
+mesure0 0.1 oval 164.5 168 97.1 100.6
+id 1 1 28 4
+mesure0 0.1 oval 173 176.5 97.1 100.6
+id 1 1 28 5
+mesure0 0.1 oval 181.5 185 97.1 100.6
+id 1 1 29 1
+mesure0 0.1 oval 20 23.5 109.95 113.45
+id 1 1 29 2
+mesure0 0.1 oval 28.5 32 109.95 113.45
+id 1 1 29 3
+mesure0 0.1 oval 37 40.5 109.95 113.45
+id 1 1 29 4
+mesure0 0.1 oval 45.5 49 109.95 113.45
+id 1 1 29 5
+mesure0 0.1 oval 54 57.5 109.95 113.45
+id 1 1 30 1
+mesure0 0.1 oval 62.5 66 109.95 113.45
+id 1 1 30 2
+mesure0 0.1 oval 71 74.5 109.95 113.45
+id 1 1 30 3
+mesure0 0.1 oval 79.5 83 109.95 113.45
+id 1 1 30 4
+mesure0 0.1 oval 88 91.5 109.95 113.45
+id 1 1 30 5
+mesure0 0.1 oval 96.5 100 109.95 113.45
+id 1 1 31 1
+mesure0 0.1 oval 105 108.5 109.95 113.45
+id 1 1 31 2
+mesure0 0.1 oval 113.5 117 109.95 113.45
+id 1 1 31 3
+mesure0 0.1 oval 122 125.5 109.95 113.45
+id 1 1 31 4
+mesure0 0.1 oval 130.5 134 109.95 113.45
+id 1 1 31 5
+mesure0 0.1 oval 139 142.5 109.95 113.45
+id 1 1 32 1
+mesure0 0.1 oval 147.5 151 109.95 113.45
+id 1 1 32 2
+mesure0 0.1 oval 156 159.5 109.95 113.45
+id 1 1 32 3
+mesure0 0.1 oval 164.5 168 109.95 113.45
+id 1 1 32 4
+mesure0 0.1 oval 173 176.5 109.95 113.45
+id 1 1 32 5
+mesure0 0.1 oval 181.5 185 109.95 113.45
+id 1 1 33 1
+mesure0 0.1 oval 20 23.5 122.8 126.3
+id 1 1 33 2
+mesure0 0.1 oval 28.5 32 122.8 126.3
+id 1 1 33 3
+mesure0 0.1 oval 37 40.5 122.8 126.3
+id 1 1 33 4
+mesure0 0.1 oval 45.5 49 122.8 126.3
+id 1 1 33 5
+mesure0 0.1 oval 54 57.5 122.8 126.3
+id 1 1 34 1
+mesure0 0.1 oval 62.5 66 122.8 126.3
+id 1 1 34 2
+mesure0 0.1 oval 71 74.5 122.8 126.3
+id 1 1 34 3
+mesure0 0.1 oval 79.5 83 122.8 126.3
+id 1 1 34 4
+mesure0 0.1 oval 88 91.5 122.8 126.3
+id 1 1 34 5
+mesure0 0.1 oval 96.5 100 122.8 126.3
+id 1 1 35 1
+mesure0 0.1 oval 105 108.5 122.8 126.3
+id 1 1 35 2
+mesure0 0.1 oval 113.5 117 122.8 126.3
+id 1 1 35 3
+mesure0 0.1 oval 122 125.5 122.8 126.3
+id 1 1 35 4
+mesure0 0.1 oval 130.5 134 122.8 126.3
+id 1 1 35 5
+mesure0 0.1 oval 139 142.5 122.8 126.3
+id 1 1 36 1
+mesure0 0.1 oval 147.5 151 122.8 126.3
+id 1 1 36 2
+mesure0 0.1 oval 156 159.5 122.8 126.3
+id 1 1 36 3
+mesure0 0.1 oval 164.5 168 122.8 126.3
+id 1 1 36 4
+mesure0 0.1 oval 173 176.5 122.8 126.3
+id 1 1 36 5
+mesure0 0.1 oval 181.5 185 122.8 126.3
+id 1 1 37 1
+mesure0 0.1 oval 20 23.5 135.65 139.15
+id 1 1 37 2
+mesure0 0.1 oval 28.5 32 135.65 139.15
+id 1 1 37 3
+mesure0 0.1 oval 37 40.5 135.65 139.15
+id 1 1 37 4
+mesure0 0.1 oval 45.5 49 135.65 139.15
+id 1 1 37 5
+mesure0 0.1 oval 54 57.5 135.65 139.15
+id 1 1 38 1
+mesure0 0.1 oval 62.5 66 135.65 139.15
+id 1 1 38 2
+mesure0 0.1 oval 71 74.5 135.65 139.15
+id 1 1 38 3
+mesure0 0.1 oval 79.5 83 135.65 139.15
+id 1 1 38 4
+mesure0 0.1 oval 88 91.5 135.65 139.15
+id 1 1 38 5
+mesure0 0.1 oval 96.5 100 135.65 139.15
+id 1 1 39 1
+mesure0 0.1 oval 105 108.5 135.65 139.15
+id 1 1 39 2
+mesure0 0.1 oval 113.5 117 135.65 139.15
+id 1 1 39 3
+mesure0 0.1 oval 122 125.5 135.65 139.15
+id 1 1 39 4
+mesure0 0.1 oval 130.5 134 135.65 139.15
+id 1 1 39 5
+mesure0 0.1 oval 139 142.5 135.65 139.15
+id 1 1 40 1
+mesure0 0.1 oval 147.5 151 135.65 139.15
+id 1 1 40 2
+mesure0 0.1 oval 156 159.5 135.65 139.15
+id 1 1 40 3
+mesure0 0.1 oval 164.5 168 135.65 139.15
+id 1 1 40 4
+mesure0 0.1 oval 173 176.5 135.65 139.15
+id 1 1 40 5
+mesure0 0.1 oval 181.5 185 135.65 139.15
+id 1 1 41 1
+mesure0 0.1 oval 20 23.5 148.5 152
+id 1 1 41 2
+mesure0 0.1 oval 28.5 32 148.5 152
+id 1 1 41 3
+mesure0 0.1 oval 37 40.5 148.5 152
+id 1 1 41 4
+mesure0 0.1 oval 45.5 49 148.5 152
+id 1 1 41 5
+mesure0 0.1 oval 54 57.5 148.5 152
+id 1 1 42 1
+mesure0 0.1 oval 62.5 66 148.5 152
+id 1 1 42 2
+mesure0 0.1 oval 71 74.5 148.5 152
+id 1 1 42 3
+mesure0 0.1 oval 79.5 83 148.5 152
+id 1 1 42 4
+mesure0 0.1 oval 88 91.5 148.5 152
+id 1 1 42 5
+mesure0 0.1 oval 96.5 100 148.5 152
+id 1 1 43 1
+mesure0 0.1 oval 105 108.5 148.5 152
+id 1 1 43 2
+mesure0 0.1 oval 113.5 117 148.5 152
+id 1 1 43 3
+mesure0 0.1 oval 122 125.5 148.5 152
+id 1 1 43 4
+mesure0 0.1 oval 130.5 134 148.5 152
+id 1 1 43 5
+mesure0 0.1 oval 139 142.5 148.5 152
+id 1 1 44 1
+mesure0 0.1 oval 147.5 151 148.5 152
+id 1 1 44 2
+mesure0 0.1 oval 156 159.5 148.5 152
+id 1 1 44 3
+mesure0 0.1 oval 164.5 168 148.5 152
+id 1 1 44 4
+mesure0 0.1 oval 173 176.5 148.5 152
+id 1 1 44 5
+mesure0 0.1 oval 181.5 185 148.5 152
+id 1 1 45 1
+mesure0 0.1 oval 20 23.5 161.35 164.85
+id 1 1 45 2
+mesure0 0.1 oval 28.5 32 161.35 164.85
+id 1 1 45 3
+mesure0 0.1 oval 37 40.5 161.35 164.85
+id 1 1 45 4
+mesure0 0.1 oval 45.5 49 161.35 164.85
+id 1 1 45 5
+mesure0 0.1 oval 54 57.5 161.35 164.85
+id 1 1 46 1
+mesure0 0.1 oval 62.5 66 161.35 164.85
+id 1 1 46 2
+mesure0 0.1 oval 71 74.5 161.35 164.85
+id 1 1 46 3
+mesure0 0.1 oval 79.5 83 161.35 164.85
+id 1 1 46 4
+mesure0 0.1 oval 88 91.5 161.35 164.85
+id 1 1 46 5
+mesure0 0.1 oval 96.5 100 161.35 164.85
+id 1 1 47 1
+mesure0 0.1 oval 105 108.5 161.35 164.85
+id 1 1 47 2
+mesure0 0.1 oval 113.5 117 161.35 164.85
+id 1 1 47 3
+mesure0 0.1 oval 122 125.5 161.35 164.85
+id 1 1 47 4
+mesure0 0.1 oval 130.5 134 161.35 164.85
+id 1 1 47 5
+mesure0 0.1 oval 139 142.5 161.35 164.85
+id 1 1 48 1
+mesure0 0.1 oval 147.5 151 161.35 164.85
+id 1 1 48 2
+mesure0 0.1 oval 156 159.5 161.35 164.85
+id 1 1 48 3
+mesure0 0.1 oval 164.5 168 161.35 164.85
+id 1 1 48 4
+mesure0 0.1 oval 173 176.5 161.35 164.85
+id 1 1 48 5
+mesure0 0.1 oval 181.5 185 161.35 164.85
+id 1 1 49 1
+mesure0 0.1 oval 20 23.5 174.2 177.7
+id 1 1 49 2
+mesure0 0.1 oval 28.5 32 174.2 177.7
+id 1 1 49 3
+mesure0 0.1 oval 37 40.5 174.2 177.7
+id 1 1 49 4
+mesure0 0.1 oval 45.5 49 174.2 177.7
+id 1 1 49 5
+mesure0 0.1 oval 54 57.5 174.2 177.7
+id 1 1 50 1
+mesure0 0.1 oval 62.5 66 174.2 177.7
+id 1 1 50 2
+mesure0 0.1 oval 71 74.5 174.2 177.7
+id 1 1 50 3
+mesure0 0.1 oval 79.5 83 174.2 177.7
+id 1 1 50 4
+mesure0 0.1 oval 88 91.5 174.2 177.7
+id 1 1 50 5
+mesure0 0.1 oval 96.5 100 174.2 177.7
+id 1 1 51 1
+mesure0 0.1 oval 105 108.5 174.2 177.7
+id 1 1 51 2
+mesure0 0.1 oval 113.5 117 174.2 177.7
+id 1 1 51 3
+mesure0 0.1 oval 122 125.5 174.2 177.7
+id 1 1 51 4
+mesure0 0.1 oval 130.5 134 174.2 177.7
+id 1 1 51 5
+mesure0 0.1 oval 139 142.5 174.2 177.7
+id 1 1 52 1
+mesure0 0.1 oval 147.5 151 174.2 177.7
+id 1 1 52 2
+mesure0 0.1 oval 156 159.5 174.2 177.7
+id 1 1 52 3
+mesure0 0.1 oval 164.5 168 174.2 177.7
+id 1 1 52 4
+mesure0 0.1 oval 173 176.5 174.2 177.7
+id 1 1 52 5
+mesure0 0.1 oval 181.5 185 174.2 177.7
+id 1 1 53 1
+mesure0 0.1 oval 20 23.5 187.05 190.55
+id 1 1 53 2
+mesure0 0.1 oval 28.5 32 187.05 190.55
+id 1 1 53 3
+mesure0 0.1 oval 37 40.5 187.05 190.55
+id 1 1 53 4
+mesure0 0.1 oval 45.5 49 187.05 190.55
+id 1 1 53 5
+mesure0 0.1 oval 54 57.5 187.05 190.55
+id 1 1 54 1
+mesure0 0.1 oval 62.5 66 187.05 190.55
+id 1 1 54 2
+mesure0 0.1 oval 71 74.5 187.05 190.55
+id 1 1 54 3
+mesure0 0.1 oval 79.5 83 187.05 190.55
+id 1 1 54 4
+mesure0 0.1 oval 88 91.5 187.05 190.55
+id 1 1 54 5
+mesure0 0.1 oval 96.5 100 187.05 190.55
+id 1 1 55 1
+mesure0 0.1 oval 105 108.5 187.05 190.55
+id 1 1 55 2
+mesure0 0.1 oval 113.5 117 187.05 190.55
+id 1 1 55 3
+mesure0 0.1 oval 122 125.5 187.05 190.55
+id 1 1 55 4
+mesure0 0.1 oval 130.5 134 187.05 190.55
+id 1 1 55 5
+mesure0 0.1 oval 139 142.5 187.05 190.55
+id 1 1 56 1
+mesure0 0.1 oval 147.5 151 187.05 190.55
+id 1 1 56 2
+mesure0 0.1 oval 156 159.5 187.05 190.55
+id 1 1 56 3
+mesure0 0.1 oval 164.5 168 187.05 190.55
+id 1 1 56 4
+mesure0 0.1 oval 173 176.5 187.05 190.55
+id 1 1 56 5
+mesure0 0.1 oval 181.5 185 187.05 190.55
+id 1 1 57 1
+mesure0 0.1 oval 20 23.5 199.9 203.4
+id 1 1 57 2
+mesure0 0.1 oval 28.5 32 199.9 203.4
+id 1 1 57 3
+mesure0 0.1 oval 37 40.5 199.9 203.4
+id 1 1 57 4
+mesure0 0.1 oval 45.5 49 199.9 203.4
+id 1 1 57 5
+mesure0 0.1 oval 54 57.5 199.9 203.4
+id 1 1 58 1
+mesure0 0.1 oval 62.5 66 199.9 203.4
+id 1 1 58 2
+mesure0 0.1 oval 71 74.5 199.9 203.4
+id 1 1 58 3
+mesure0 0.1 oval 79.5 83 199.9 203.4
+id 1 1 58 4
+mesure0 0.1 oval 88 91.5 199.9 203.4
+id 1 1 58 5
+mesure0 0.1 oval 96.5 100 199.9 203.4
+id 1 1 59 1
+mesure0 0.1 oval 105 108.5 199.9 203.4
+id 1 1 59 2
+mesure0 0.1 oval 113.5 117 199.9 203.4
+id 1 1 59 3
+mesure0 0.1 oval 122 125.5 199.9 203.4
+id 1 1 59 4
+mesure0 0.1 oval 130.5 134 199.9 203.4
+id 1 1 59 5
+mesure0 0.1 oval 139 142.5 199.9 203.4
+id 1 1 60 1
+mesure0 0.1 oval 147.5 151 199.9 203.4
+id 1 1 60 2
+mesure0 0.1 oval 156 159.5 199.9 203.4
+id 1 1 60 3
+mesure0 0.1 oval 164.5 168 199.9 203.4
+id 1 1 60 4
+mesure0 0.1 oval 173 176.5 199.9 203.4
+id 1 1 60 5
+mesure0 0.1 oval 181.5 185 199.9 203.4
+id 1 1 61 1
+mesure0 0.1 oval 20 23.5 212.75 216.25
+id 1 1 61 2
+mesure0 0.1 oval 28.5 32 212.75 216.25
+id 1 1 61 3
+mesure0 0.1 oval 37 40.5 212.75 216.25
+id 1 1 61 4
+mesure0 0.1 oval 45.5 49 212.75 216.25
+id 1 1 61 5
+mesure0 0.1 oval 54 57.5 212.75 216.25
+id 1 1 62 1
+mesure0 0.1 oval 62.5 66 212.75 216.25
+id 1 1 62 2
+mesure0 0.1 oval 71 74.5 212.75 216.25
+id 1 1 62 3
+mesure0 0.1 oval 79.5 83 212.75 216.25
+id 1 1 62 4
+mesure0 0.1 oval 88 91.5 212.75 216.25
+id 1 1 62 5
+mesure0 0.1 oval 96.5 100 212.75 216.25
+id 1 1 63 1
+mesure0 0.1 oval 105 108.5 212.75 216.25
+id 1 1 63 2
+mesure0 0.1 oval 113.5 117 212.75 216.25
+id 1 1 63 3
+mesure0 0.1 oval 122 125.5 212.75 216.25
+id 1 1 63 4
+mesure0 0.1 oval 130.5 134 212.75 216.25
+id 1 1 63 5
+mesure0 0.1 oval 139 142.5 212.75 216.25
+id 1 1 64 1
+mesure0 0.1 oval 147.5 151 212.75 216.25
+id 1 1 64 2
+mesure0 0.1 oval 156 159.5 212.75 216.25
+id 1 1 64 3
+mesure0 0.1 oval 164.5 168 212.75 216.25
+id 1 1 64 4
+mesure0 0.1 oval 173 176.5 212.75 216.25
+id 1 1 64 5
+mesure0 0.1 oval 181.5 185 212.75 216.25
+id 1 1 65 1
+mesure0 0.1 oval 20 23.5 225.6 229.1
+id 1 1 65 2
+mesure0 0.1 oval 28.5 32 225.6 229.1
+id 1 1 65 3
+mesure0 0.1 oval 37 40.5 225.6 229.1
+id 1 1 65 4
+mesure0 0.1 oval 45.5 49 225.6 229.1
+id 1 1 65 5
+mesure0 0.1 oval 54 57.5 225.6 229.1
+id 1 1 66 1
+mesure0 0.1 oval 62.5 66 225.6 229.1
+id 1 1 66 2
+mesure0 0.1 oval 71 74.5 225.6 229.1
+id 1 1 66 3
+mesure0 0.1 oval 79.5 83 225.6 229.1
+id 1 1 66 4
+mesure0 0.1 oval 88 91.5 225.6 229.1
+id 1 1 66 5
+mesure0 0.1 oval 96.5 100 225.6 229.1
+id 1 1 67 1
+mesure0 0.1 oval 105 108.5 225.6 229.1
+id 1 1 67 2
+mesure0 0.1 oval 113.5 117 225.6 229.1
+id 1 1 67 3
+mesure0 0.1 oval 122 125.5 225.6 229.1
+id 1 1 67 4
+mesure0 0.1 oval 130.5 134 225.6 229.1
+id 1 1 67 5
+mesure0 0.1 oval 139 142.5 225.6 229.1
+id 1 1 68 1
+mesure0 0.1 oval 147.5 151 225.6 229.1
+id 1 1 68 2
+mesure0 0.1 oval 156 159.5 225.6 229.1
+id 1 1 68 3
+mesure0 0.1 oval 164.5 168 225.6 229.1
+id 1 1 68 4
+mesure0 0.1 oval 173 176.5 225.6 229.1
+id 1 1 68 5
+mesure0 0.1 oval 181.5 185 225.6 229.1
+id 1 1 69 1
+mesure0 0.1 oval 20 23.5 238.45 241.95
+id 1 1 69 2
+mesure0 0.1 oval 28.5 32 238.45 241.95
+id 1 1 69 3
+mesure0 0.1 oval 37 40.5 238.45 241.95
+id 1 1 69 4
+mesure0 0.1 oval 45.5 49 238.45 241.95
+id 1 1 69 5
+mesure0 0.1 oval 54 57.5 238.45 241.95
+id 1 1 70 1
+mesure0 0.1 oval 62.5 66 238.45 241.95
+id 1 1 70 2
+mesure0 0.1 oval 71 74.5 238.45 241.95
+id 1 1 70 3
+mesure0 0.1 oval 79.5 83 238.45 241.95
+id 1 1 70 4
+mesure0 0.1 oval 88 91.5 238.45 241.95
+id 1 1 70 5
+mesure0 0.1 oval 96.5 100 238.45 241.95
+id 1 1 71 1
+mesure0 0.1 oval 105 108.5 238.45 241.95
+id 1 1 71 2
+mesure0 0.1 oval 113.5 117 238.45 241.95
+id 1 1 71 3
+mesure0 0.1 oval 122 125.5 238.45 241.95
+id 1 1 71 4
+mesure0 0.1 oval 130.5 134 238.45 241.95
+id 1 1 71 5
+mesure0 0.1 oval 139 142.5 238.45 241.95
+id 1 1 72 1
+mesure0 0.1 oval 147.5 151 238.45 241.95
+id 1 1 72 2
+mesure0 0.1 oval 156 159.5 238.45 241.95
+id 1 1 72 3
+mesure0 0.1 oval 164.5 168 238.45 241.95
+id 1 1 72 4
+mesure0 0.1 oval 173 176.5 238.45 241.95
+id 1 1 72 5
+mesure0 0.1 oval 181.5 185 238.45 241.95
+id 1 1 73 1
+mesure0 0.1 oval 20 23.5 251.3 254.8
+id 1 1 73 2
+mesure0 0.1 oval 28.5 32 251.3 254.8
+id 1 1 73 3
+mesure0 0.1 oval 37 40.5 251.3 254.8
+id 1 1 73 4
+mesure0 0.1 oval 45.5 49 251.3 254.8
+id 1 1 73 5
+mesure0 0.1 oval 54 57.5 251.3 254.8
+id 1 1 74 1
+mesure0 0.1 oval 62.5 66 251.3 254.8
+id 1 1 74 2
+mesure0 0.1 oval 71 74.5 251.3 254.8
+id 1 1 74 3
+mesure0 0.1 oval 79.5 83 251.3 254.8
+id 1 1 74 4
+mesure0 0.1 oval 88 91.5 251.3 254.8
+id 1 1 74 5
+mesure0 0.1 oval 96.5 100 251.3 254.8
+id 1 1 75 1
+mesure0 0.1 oval 105 108.5 251.3 254.8
+id 1 1 75 2
+mesure0 0.1 oval 113.5 117 251.3 254.8
+id 1 1 75 3
+mesure0 0.1 oval 122 125.5 251.3 254.8
+id 1 1 75 4
+mesure0 0.1 oval 130.5 134 251.3 254.8
+id 1 1 75 5
+mesure0 0.1 oval 139 142.5 251.3 254.8
+id 1 1 76 1
+mesure0 0.1 oval 147.5 151 251.3 254.8
+id 1 1 76 2
+mesure0 0.1 oval 156 159.5 251.3 254.8
+id 1 1 76 3
+mesure0 0.1 oval 164.5 168 251.3 254.8
+id 1 1 76 4
+mesure0 0.1 oval 173 176.5 251.3 254.8
+id 1 1 76 5
+mesure0 0.1 oval 181.5 185 251.3 254.8
+id 1 1 77 1
+mesure0 0.1 oval 20 23.5 264.15 267.65
+id 1 1 77 2
+mesure0 0.1 oval 28.5 32 264.15 267.65
+id 1 1 77 3
+mesure0 0.1 oval 37 40.5 264.15 267.65
+id 1 1 77 4
+mesure0 0.1 oval 45.5 49 264.15 267.65
+id 1 1 77 5
+mesure0 0.1 oval 54 57.5 264.15 267.65
+id 1 1 78 1
+mesure0 0.1 oval 62.5 66 264.15 267.65
+id 1 1 78 2
+mesure0 0.1 oval 71 74.5 264.15 267.65
+id 1 1 78 3
+mesure0 0.1 oval 79.5 83 264.15 267.65
+id 1 1 78 4
+mesure0 0.1 oval 88 91.5 264.15 267.65
+id 1 1 78 5
+mesure0 0.1 oval 96.5 100 264.15 267.65
+id 1 1 79 1
+mesure0 0.1 oval 105 108.5 264.15 267.65
+id 1 1 79 2
+mesure0 0.1 oval 113.5 117 264.15 267.65
+id 1 1 79 3
+mesure0 0.1 oval 122 125.5 264.15 267.65
+id 1 1 79 4
+mesure0 0.1 oval 130.5 134 264.15 267.65
+id 1 1 79 5
+mesure0 0.1 oval 139 142.5 264.15 267.65
+id 1 1 80 1
+mesure0 0.1 oval 147.5 151 264.15 267.65
+id 1 1 80 2
+mesure0 0.1 oval 156 159.5 264.15 267.65
+id 1 1 80 3
+mesure0 0.1 oval 164.5 168 264.15 267.65
+id 1 1 80 4
+mesure0 0.1 oval 173 176.5 264.15 267.65
+id 1 1 80 5
+mesure0 0.1 oval 181.5 185 264.15 267.65
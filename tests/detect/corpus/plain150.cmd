@@ -0,0 +1,202 @@
+load plain150.png
+optim 10,10 200,10 200,287 10,287
+id 1 1 1 1
+mesure0 0.1 square 20 23.5 20 23.5
+id 1 1 1 2
+mesure0 0.1 square 28.5 32 20 23.5
+id 1 1 1 3
+mesure0 0.1 square 37 40.5 20 23.5
+id 1 1 1 4
+mesure0 0.1 square 45.5 49 20 23.5
+id 1 1 1 5
+mesure0 0.1 square 54 57.5 20 23.5
+id 1 1 2 1
+mesure0 0.1 square 62.5 66 20 23.5
+id 1 1 2 2
+mesure0 0.1 square 71 74.5 20 23.5
+id 1 1 2 3
+mesure0 0.1 square 79.5 83 20 23.5
+id 1 1 2 4
+mesure0 0.1 square 88 91.5 20 23.5
+id 1 1 2 5
+mesure0 0.1 square 96.5 100 20 23.5
+id 1 1 3 1
+mesure0 0.1 square 105 108.5 20 23.5
+id 1 1 3 2
+mesure0 0.1 square 113.5 117 20 23.5
+id 1 1 3 3
+mesure0 0.1 square 122 125.5 20 23.5
+id 1 1 3 4
+mesure0 0.1 square 130.5 134 20 23.5
+id 1 1 3 5
+mesure0 0.1 square 139 142.5 20 23.5
+id 1 1 4 1
+mesure0 0.1 square 147.5 151 20 23.5
+id 1 1 4 2
+mesure0 0.1 square 156 159.5 20 23.5
+id 1 1 4 3
+mesure0 0.1 square 164.5 168 20 23.5
+id 1 1 4 4
+mesure0 0.1 square 173 176.5 20 23.5
+id 1 1 4 5
+mesure0 0.1 square 181.5 185 20 23.5
+id 1 1 5 1
+mesure0 0.1 square 20 23.5 32.85 36.35
+id 1 1 5 2
+mesure0 0.1 square 28.5 32 32.85 36.35
+id 1 1 5 3
+mesure0 0.1 square 37 40.5 32.85 36.35
+id 1 1 5 4
+mesure0 0.1 square 45.5 49 32.85 36.35
+id 1 1 5 5
+mesure0 0.1 square 54 57.5 32.85 36.35
+id 1 1 6 1
+mesure0 0.1 square 62.5 66 32.85 36.35
+id 1 1 6 2
+mesure0 0.1 square 71 74.5 32.85 36.35
+id 1 1 6 3
+mesure0 0.1 square 79.5 83 32.85 36.35
+id 1 1 6 4
+mesure0 0.1 square 88 91.5 32.85 36.35
+id 1 1 6 5
+mesure0 0.1 square 96.5 100 32.85 36.35
+id 1 1 7 1
+mesure0 0.1 square 105 108.5 32.85 36.35
+id 1 1 7 2
+mesure0 0.1 square 113.5 117 32.85 36.35
+id 1 1 7 3
+mesure0 0.1 square 122 125.5 32.85 36.35
+id 1 1 7 4
+mesure0 0.1 square 130.5 134 32.85 36.35
+id 1 1 7 5
+mesure0 0.1 square 139 142.5 32.85 36.35
+id 1 1 8 1
+mesure0 0.1 square 147.5 151 32.85 36.35
+id 1 1 8 2
+mesure0 0.1 square 156 159.5 32.85 36.35
+id 1 1 8 3
+mesure0 0.1 square 164.5 168 32.85 36.35
+id 1 1 8 4
+mesure0 0.1 square 173 176.5 32.85 36.35
+id 1 1 8 5
+mesure0 0.1 square 181.5 185 32.85 36.35
+id 1 1 9 1
+mesure0 0.1 square 20 23.5 45.7 49.2
+id 1 1 9 2
+mesure0 0.1 square 28.5 32 45.7 49.2
+id 1 1 9 3
+mesure0 0.1 square 37 40.5 45.7 49.2
+id 1 1 9 4
+mesure0 0.1 square 45.5 49 45.7 49.2
+id 1 1 9 5
+mesure0 0.1 square 54 57.5 45.7 49.2
+id 1 1 10 1
+mesure0 0.1 square 62.5 66 45.7 49.2
+id 1 1 10 2
+mesure0 0.1 square 71 74.5 45.7 49.2
+id 1 1 10 3
+mesure0 0.1 square 79.5 83 45.7 49.2
+id 1 1 10 4
+mesure0 0.1 square 88 91.5 45.7 49.2
+id 1 1 10 5
+mesure0 0.1 square 96.5 100 45.7 49.2
+id 1 1 11 1
+mesure0 0.1 square 105 108.5 45.7 49.2
+id 1 1 11 2
+mesure0 0.1 square 113.5 117 45.7 49.2
+id 1 1 11 3
+mesure0 0.1 square 122 125.5 45.7 49.2
+id 1 1 11 4
+mesure0 0.1 square 130.5 134 45.7 49.2
+id 1 1 11 5
+mesure0 0.1 square 139 142.5 45.7 49.2
+id 1 1 12 1
+mesure0 0.1 square 147.5 151 45.7 49.2
+id 1 1 12 2
+mesure0 0.1 square 156 159.5 45.7 49.2
+id 1 1 12 3
+mesure0 0.1 square 164.5 168 45.7 49.2
+id 1 1 12 4
+mesure0 0.1 square 173 176.5 45.7 49.2
+id 1 1 12 5
+mesure0 0.1 square 181.5 185 45.7 49.2
+id 1 1 13 1
+mesure0 0.1 square 20 23.5 58.55 62.05
+id 1 1 13 2
+mesure0 0.1 square 28.5 32 58.55 62.05
+id 1 1 13 3
+mesure0 0.1 square 37 40.5 58.55 62.05
+id 1 1 13 4
+mesure0 0.1 square 45.5 49 58.55 62.05
+id 1 1 13 5
+mesure0 0.1 square 54 57.5 58.55 62.05
+id 1 1 14 1
+mesure0 0.1 square 62.5 66 58.55 62.05
+id 1 1 14 2
+mesure0 0.1 square 71 74.5 58.55 62.05
+id 1 1 14 3
+mesure0 0.1 square 79.5 83 58.55 62.05
+id 1 1 14 4
+mesure0 0.1 square 88 91.5 58.55 62.05
+id 1 1 14 5
+mesure0 0.1 square 96.5 100 58.55 62.05
+id 1 1 15 1
+mesure0 0.1 square 105 108.5 58.55 62.05
+id 1 1 15 2
+mesure0 0.1 square 113.5 117 58.55 62.05
+id 1 1 15 3
+mesure0 0.1 square 122 125.5 58.55 62.05
+id 1 1 15 4
+mesure0 0.1 square 130.5 134 58.55 62.05
+id 1 1 15 5
+mesure0 0.1 square 139 142.5 58.55 62.05
+id 1 1 16 1
+mesure0 0.1 square 147.5 151 58.55 62.05
+id 1 1 16 2
+mesure0 0.1 square 156 159.5 58.55 62.05
+id 1 1 16 3
+mesure0 0.1 square 164.5 168 58.55 62.05
+id 1 1 16 4
+mesure0 0.1 square 173 176.5 58.55 62.05
+id 1 1 16 5
+mesure0 0.1 square 181.5 185 58.55 62.05
+id 1 1 17 1
+mesure0 0.1 square 20 23.5 71.4 74.9
+id 1 1 17 2
+mesure0 0.1 square 28.5 32 71.4 74.9
+id 1 1 17 3
+mesure0 0.1 square 37 40.5 71.4 74.9
+id 1 1 17 4
+mesure0 0.1 square 45.5 49 71.4 74.9
+id 1 1 17 5
+mesure0 0.1 square 54 57.5 71.4 74.9
+id 1 1 18 1
+mesure0 0.1 square 62.5 66 71.4 74.9
+id 1 1 18 2
+mesure0 0.1 square 71 74.5 71.4 74.9
+id 1 1 18 3
+mesure0 0.1 square 79.5 83 71.4 74.9
+id 1 1 18 4
+mesure0 0.1 square 88 91.5 71.4 74.9
+id 1 1 18 5
+mesure0 0.1 square 96.5 100 71.4 74.9
+id 1 1 19 1
+mesure0 0.1 square 105 108.5 71.4 74.9
+id 1 1 19 2
+mesure0 0.1 square 113.5 117 71.4 74.9
+id 1 1 19 3
+mesure0 0.1 square 122 125.5 71.4 74.9
+id 1 1 19 4
+mesure0 0.1 square 130.5 134 71.4 74.9
+id 1 1 19 5
+mesure0 0.1 square 139 142.5 71.4 74.9
+id 1 1 20 1
+mesure0 0.1 square 147.5 151 71.4 74.9
+id 1 1 20 2
+mesure0 0.1 square 156 159.5 71.4 74.9
+id 1 1 20 3
+mesure0 0.1 square 164.5 168 71.4 74.9
+id 1 1 20 4
+mesure0 0.1 square 173 176.5 71.4 74.9
+id 1 1 20 5
+mesure0 0.1 square 181.5 185 71.4 74.9
@@ -0,0 +1,215 @@
+#! /usr/bin/env perl
+#
+# Copyright (C) 2026 Alexis Bienvenüe <paamc@passoire.fr>
+#
+# This file is part of Auto-Multiple-Choice
+#
+# Auto-Multiple-Choice is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 2 of
+# the License, or (at your option) any later version.
+#
+# Auto-Multiple-Choice is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Auto-Multiple-Choice.  If not, see
+# <http://www.gnu.org/licenses/>.
+
+# golden.pl replays AMC-detect command streams from a corpus
+# directory, and compares the numeric results with golden outputs.
+#
+# For each NAME.cmd file in the corpus directory, AMC-detect is run
+# (from the corpus directory) with the options read from NAME.args,
+# and the commands from NAME.cmd. With --record, its output is saved
+# to NAME.golden. Otherwise, the output is compared to NAME.golden:
+#
+# - Frame[i], TCORNER and COIN coordinates, with tolerance
+#   --frame-tolerance (in pixels)
+# - the transform coefficients, MSE and QUALITY, with tolerance
+#   --transfo-tolerance
+# - PIX black/total pixels counts, with tolerance --pix-tolerance
+#   (default: exact)
+# - error lines (starting with !), exactly
+#
+# Moreover, the boxes whose darkness ratio is on different sides of
+# the ticking threshold (--threshold and --threshold-up, as in
+# AMC-note) in the golden and current outputs are reported.
+#
+# The exit status is 1 if any difference has been found.
+#
+# see tests/detect/Makefile to build a corpus from synthetic scans.
+
+use warnings;
+use 5.012;
+
+use Getopt::Long;
+use IPC::Run qw(run);
+use File::Basename;
+use File::Spec;
+
+my $detect            = '../../AMC-detect';
+my $record            = '';
+my $frame_tolerance   = 0.01;
+my $transfo_tolerance = 1e-4;
+my $pix_tolerance     = 0;
+my $threshold         = 0.15;
+my $threshold_up      = 1.0;
+
+GetOptions(
+    "detect=s"            => \$detect,
+    "record!"             => \$record,
+    "frame-tolerance=s"   => \$frame_tolerance,
+    "transfo-tolerance=s" => \$transfo_tolerance,
+    "pix-tolerance=s"     => \$pix_tolerance,
+    "threshold=s"         => \$threshold,
+    "threshold-up=s"      => \$threshold_up,
+);
+
+my $corpus = shift || 'corpus';
+
+$detect = File::Spec->rel2abs($detect);
+
+die "No AMC-detect executable: $detect" if ( !-x $detect );
+
+# reads the results from AMC-detect output. Returns a hash ref
+# key => [type, values...], and the keys list (in output order).
+
+sub parse_output {
+    my ($output) = @_;
+    my %v        = ();
+    my @keys     = ();
+    my $cmd      = 0;
+    my $box      = '';
+    my %n        = ();
+
+    my $add = sub {
+        my ( $key, @data ) = @_;
+        if ( $v{$key} ) {
+            $key .= '#' . ( ++$n{$key} );
+        }
+        push @keys, $key;
+        $v{$key} = [@data];
+    };
+
+    for ( split( /\n/, $output ) ) {
+        if (/^__END__$/) {
+            $cmd++;
+            $box = '';
+        } elsif (/^BOX\s+([0-9]+)\s+([0-9]+)$/) {
+            $box = "$1.$2";
+        } elsif (/^Frame\[([0-9]+)\]:\s*(-?[0-9.]+)\s*;\s*(-?[0-9.]+)/) {
+            &$add( "$cmd:Frame[$1]", 'frame', $2, $3 );
+        } elsif (/^(TCORNER|COIN)\s+(-?[0-9.]+),(-?[0-9.]+)$/) {
+            &$add( "$cmd:$box:$1", 'frame', $2, $3 );
+        } elsif (/^([a-f])=(-?[0-9.]+)$/) {
+            &$add( "$cmd:$1", 'transfo', $2 );
+        } elsif (/^(MSE|QUALITY)=(-?[0-9.]+)$/) {
+            &$add( "$cmd:$1", 'transfo', $2 );
+        } elsif (/^PIX\s+([0-9]+)\s+([0-9]+)$/) {
+            &$add( "$cmd:$box:PIX", 'pix', $1, $2 );
+        } elsif (/^!/) {
+            &$add( "$cmd:error", 'text', $_ );
+        }
+    }
+    return ( \%v, @keys );
+}
+
+sub ticked {
+    my ( $black, $total ) = @_;
+    my $r = ( $total > 0 ? $black / $total : 0 );
+    return ( $r > $threshold && $r < $threshold_up ? 1 : 0 );
+}
+
+# compares two results, and returns the list of differences
+
+sub compare {
+    my ( $golden, $current, @keys ) = @_;
+    my @d = ();
+
+    for my $k (@keys) {
+        my $g = $golden->{$k};
+        my $c = $current->{$k};
+        if ( !$c ) {
+            push @d, "$k: missing";
+            next;
+        }
+        my ( $type, @gv ) = @$g;
+        my ( undef, @cv ) = @$c;
+        if ( $type eq 'text' ) {
+            push @d, "$k: [$gv[0]] -> [$cv[0]]" if ( $gv[0] ne $cv[0] );
+            next;
+        }
+        my $tol = (
+              $type eq 'frame'   ? $frame_tolerance
+            : $type eq 'transfo' ? $transfo_tolerance
+            :                      $pix_tolerance
+        );
+        my $diff = 0;
+        for my $i ( 0 .. $#gv ) {
+            $diff = 1 if ( abs( $gv[$i] - $cv[$i] ) > $tol );
+        }
+        push @d, "$k: " . join( ' ', @gv ) . " -> " . join( ' ', @cv )
+          if ($diff);
+        if ( $type eq 'pix' && ticked(@gv) != ticked(@cv) ) {
+            push @d,
+              sprintf( "$k: TICK CHANGE %.4f -> %.4f",
+                ( $gv[1] > 0 ? $gv[0] / $gv[1] : 0 ),
+                ( $cv[1] > 0 ? $cv[0] / $cv[1] : 0 ) );
+        }
+    }
+    for my $k ( keys %$current ) {
+        push @d, "$k: unexpected" if ( !$golden->{$k} );
+    }
+    return (@d);
+}
+
+sub file_content {
+    my ($file) = @_;
+    open( my $fh, "<", $file ) or die "Can't read $file: $!";
+    local $/;
+    my $c = <$fh>;
+    close($fh);
+    return ($c);
+}
+
+my $failed = 0;
+
+for my $cmd_file ( sort glob("$corpus/*.cmd") ) {
+    my $name = basename( $cmd_file, '.cmd' );
+    my $args = "$corpus/$name.args";
+    my @args = ( -f $args ? split( /\s+/, file_content($args) ) : () );
+    @args = grep { $_ ne '' } @args;
+
+    my $output;
+    my $commands = file_content($cmd_file);
+    run(
+        [ $detect, @args ], '<', \$commands, '>', \$output,
+        init => sub { chdir($corpus) }
+    );
+
+    my $golden_file = "$corpus/$name.golden";
+    if ($record) {
+        open( my $fh, ">", $golden_file ) or die "Can't write $golden_file: $!";
+        print $fh $output;
+        close($fh);
+        print "[ REC] $name\n";
+    } elsif ( !-f $golden_file ) {
+        print "[ -- ] $name: no golden output\n";
+    } else {
+        my ( $golden, @keys ) = parse_output( file_content($golden_file) );
+        my ($current) = parse_output($output);
+        my @d = compare( $golden, $current, @keys );
+        if (@d) {
+            $failed = 1;
+            print "[FAIL] $name: " . ( 0 + @d ) . " differences\n";
+            print "       $_\n" for (@d);
+        } else {
+            print "[ OK ] $name (" . ( 0 + @keys ) . " values)\n";
+        }
+    }
+}
+
+exit($failed);
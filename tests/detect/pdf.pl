@@ -0,0 +1,84 @@
+#! /usr/bin/env perl
+#
+# Copyright (C) 2026 Alexis Bienvenüe <paamc@passoire.fr>
+#
+# This file is part of Auto-Multiple-Choice
+#
+# Auto-Multiple-Choice is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 2 of
+# the License, or (at your option) any later version.
+#
+# Auto-Multiple-Choice is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Auto-Multiple-Choice.  If not, see
+# <http://www.gnu.org/licenses/>.
+
+# pdf.pl checks that AMC-detect loads pages from PDF files with
+# "load file#page" as expected, and that it does not crash on
+# malformed PDF files. The files, pages and expected results are
+# listed in the pages file of the PDF directory.
+#
+# When AMC-detect has been built without poppler, the checks are
+# skipped. The exit status is 1 if any check failed.
+
+use warnings;
+use 5.012;
+
+use Getopt::Long;
+use IPC::Run qw(run);
+use File::Spec;
+
+my $detect = '../../AMC-detect';
+
+GetOptions( "detect=s" => \$detect, );
+
+my $dir = shift || 'pdf';
+
+$detect = File::Spec->rel2abs($detect);
+
+die "No AMC-detect executable: $detect" if ( !-x $detect );
+
+open( my $list, "<", "$dir/pages" ) or die "Can't read $dir/pages: $!";
+
+my $failed = 0;
+
+while (<$list>) {
+    chomp;
+    next if ( /^\s*#/ || !/\S/ );
+    my ( $file, $page, $expected ) = split(/\s+/);
+
+    my ( $output, $errors ) = ( '', '' );
+    my $commands = "load $file#$page\n";
+    run(
+        [$detect], '<', \$commands, '>', \$output, '2>', \$errors,
+        init => sub { chdir($dir) }
+    );
+    my $status = $?;
+
+    if ( $output =~ /built without poppler/ ) {
+        print "[SKIP] AMC-detect was built without poppler\n";
+        last;
+    }
+
+    my $result = ( $output =~ /^! LOAD/m ? 'error' : 'ok' );
+    my $name   = "$file#$page";
+    if ( $status != 0 || $output !~ /^__END__$/m ) {
+        $failed = 1;
+        print "[FAIL] $name: AMC-detect exit status $status\n";
+    } elsif ( $expected ne 'any' && $result ne $expected ) {
+        $failed = 1;
+        print "[FAIL] $name: $result instead of $expected\n";
+        print "       $_\n" for ( grep { /^!/ } split( /\n/, $output ) );
+    } else {
+        print "[ OK ] $name ($result)\n";
+    }
+}
+
+close($list);
+
+exit($failed);